@@ -0,0 +1,153 @@
+#include "batch.h"
+#include "kmeans.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <climits>
+#include <omp.h>
+
+BatchJob::BatchJob(const std::string& path, int k, int iterations, int size)
+    : dataset_path(path), num_clusters(k), max_iterations(iterations), subset_size(size),
+      num_points(0), iterations(0), converged(false), seconds(0.0), ok(false) {}
+
+// Parses a whole field as an int; surrounding spaces (and the '\r' of CRLF files) are allowed
+static bool parseIntField(const std::string& field, int& value) {
+    const char* field_cstr = field.c_str();
+    char* end_ptr;
+    long parsed = std::strtol(field_cstr, &end_ptr, 10);
+    if (end_ptr == field_cstr || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    while (*end_ptr == ' ' || *end_ptr == '\t' || *end_ptr == '\r') {
+        ++end_ptr;
+    }
+    value = static_cast<int>(parsed);
+    return *end_ptr == '\0';
+}
+
+bool loadManifest(const std::string& filepath, std::vector<BatchJob>& jobs) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening manifest: " << filepath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 1;
+
+    // Skip the header
+    if (std::getline(file, line)) {}
+
+    while (std::getline(file, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::stringstream fields(line);
+        std::string path, k, iterations, size;
+        if (!std::getline(fields, path, ',') || !std::getline(fields, k, ',') ||
+            !std::getline(fields, iterations, ',') || !std::getline(fields, size, ',')) {
+            std::cerr << "Invalid format at the line " << line_number << ": " << line << std::endl;
+            return false;
+        }
+        int num_clusters, max_iterations, subset_size;
+        if (!parseIntField(k, num_clusters) || !parseIntField(iterations, max_iterations) ||
+            !parseIntField(size, subset_size)) {
+            std::cerr << "Parsing error at line " << line_number << ": " << line << std::endl;
+            return false;
+        }
+        if (num_clusters <= 0 || max_iterations < 0 || subset_size <= 0) {
+            std::cerr << "Invalid values at line " << line_number
+                      << " (num_clusters and subset_size must be > 0, iterations >= 0): " << line << std::endl;
+            return false;
+        }
+        jobs.emplace_back(path, num_clusters, max_iterations, subset_size);
+    }
+    return true;
+}
+
+// Loads and clusters one job with whatever threads the enclosing region allows
+static void runJob(BatchJob& job) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Point> points = loadSubset(job.dataset_path, job.subset_size);
+    job.num_points = points.size();
+    if (!points.empty() && job.num_clusters > 0) {
+        std::vector<Centroid> centroids;
+        KMeans kmeans(job.num_clusters, job.max_iterations);
+        kmeans.verbose = false;
+        kmeans.run(points, centroids);
+
+        job.iterations = kmeans.completed_iterations;
+        job.converged = kmeans.has_converged;
+        job.ok = true;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    job.seconds = duration.count();
+}
+
+void runBatch(std::vector<BatchJob>& jobs, int big_job_size) {
+    // Largest jobs first (estimated work: points times clusters), so the small tail balances the load
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&jobs](size_t a, size_t b) {
+        return static_cast<double>(jobs[a].subset_size) * jobs[a].num_clusters >
+               static_cast<double>(jobs[b].subset_size) * jobs[b].num_clusters;
+    });
+
+    std::vector<size_t> big_jobs, small_jobs;
+    for (size_t i : order) {
+        if (jobs[i].subset_size >= big_job_size) {
+            big_jobs.push_back(i);
+        } else {
+            small_jobs.push_back(i);
+        }
+    }
+
+    auto batch_start = std::chrono::high_resolution_clock::now();
+
+    // Big jobs one at a time, each using all threads inside the KMeans kernels
+    for (size_t i : big_jobs) {
+        runJob(jobs[i]);
+    }
+
+    // Small jobs concurrently, one thread each: nested parallel regions in the kernels stay inactive
+    int previous_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(1);
+
+    #pragma omp parallel for schedule(dynamic, 1) default(none) shared(jobs, small_jobs)
+    for (size_t s = 0; s < small_jobs.size(); ++s) {
+        runJob(jobs[small_jobs[s]]);
+    }
+
+    omp_set_max_active_levels(previous_levels);
+
+    auto batch_end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> batch_duration = batch_end - batch_start;
+
+    int failed = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob& job = jobs[i];
+        if (!job.ok) {
+            failed++;
+            std::cout << "Job " << i << " (" << job.dataset_path << "): failed." << std::endl;
+            continue;
+        }
+        std::cout << "Job " << i << " (" << job.dataset_path << ", " << job.num_points << " points, "
+                  << job.num_clusters << " clusters): " << job.iterations << " iterations, "
+                  << (job.converged ? "converged" : "not converged") << ", "
+                  << job.seconds << " seconds." << std::endl;
+    }
+
+    std::cout << "Batch: " << jobs.size() << " jobs (" << big_jobs.size() << " big, " << small_jobs.size()
+              << " small, " << failed << " failed) in " << batch_duration.count() << " seconds, "
+              << jobs.size() / batch_duration.count() << " jobs/s." << std::endl;
+}
@@ -0,0 +1,30 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+#include <string>
+
+// One independent clustering problem of a batch manifest
+struct BatchJob {
+    std::string dataset_path;
+    int num_clusters;
+    int max_iterations;
+    int subset_size;
+
+    // Results filled in by runBatch
+    size_t num_points;
+    int iterations;
+    bool converged;
+    double seconds;
+    bool ok;
+
+    BatchJob(const std::string& path, int k, int iterations, int size);
+};
+
+// Manifest: header line followed by "dataset_path,num_clusters,iterations,subset_size" lines
+bool loadManifest(const std::string& filepath, std::vector<BatchJob>& jobs);
+
+// Runs all jobs; jobs with at least big_job_size points get every thread, the others share the cores one thread each
+void runBatch(std::vector<BatchJob>& jobs, int big_job_size);
+
+#endif
@@ -0,0 +1,152 @@
+#include "bisect.h"
+#include "kmeans.h"
+#include <algorithm>
+#include <utility>
+#include <omp.h>
+
+// A cluster of the bisection: the contiguous points [begin, begin + size) of the partitioned array
+struct BisectNode {
+    size_t begin;
+    size_t size;
+    double sse;     // Sum of squared distances to the cluster mean, 0 once the cluster cannot be split
+};
+
+// Moves the points labelled 0 in front of the others, swapping their rows alongside; returns the size of the first group
+static size_t partitionByLabel(Point* points, size_t* rows, size_t num_points) {
+    size_t left = 0;
+    size_t right = num_points;
+    while (true) {
+        while (left < right && points[left].cluster_id == 0) {
+            ++left;
+        }
+        while (left < right && points[right - 1].cluster_id != 0) {
+            --right;
+        }
+        if (left >= right) {
+            return left;
+        }
+        std::swap(points[left], points[right - 1]);
+        std::swap(rows[left], rows[right - 1]);
+        ++left;
+        --right;
+    }
+}
+
+// Runs 2-means on the node's own points and partitions them into the two halves.
+// Returns false if the node cannot be split (all its points coincide).
+static bool splitNode(Point* points, size_t* rows, int max_iterations, const BisectNode& node, BisectNode children[2]) {
+    Point* node_points = points + node.begin;
+
+    KMeans two_means(2, max_iterations);
+    two_means.verbose = false;
+    two_means.random.reseed(42u + static_cast<unsigned int>(node.begin));   // Same result whatever thread runs the node
+    std::vector<Centroid> halves;
+    two_means.run(node_points, node.size, halves);
+    two_means.assignPointsToClusters(node_points, node.size, halves);
+
+    size_t left_size = partitionByLabel(node_points, rows + node.begin, node.size);
+    size_t right_size = node.size - left_size;
+    if (left_size == 0 || right_size == 0) {
+        return false;
+    }
+
+    children[0] = {node.begin, left_size, two_means.computeInertia(node_points, left_size, halves)};
+    children[1] = {node.begin + left_size, right_size,
+                   two_means.computeInertia(node_points + left_size, right_size, halves)};
+    return true;
+}
+
+void runBisecting(std::vector<Point>& points, std::vector<Centroid>& centroids, int num_clusters, int max_iterations) {
+    size_t n = points.size();
+    std::vector<size_t> rows(n);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        rows[i] = i;
+    }
+
+    // Clusters at least this large are split one at a time with every thread working in the kernels,
+    // smaller ones are split concurrently with one thread each
+    size_t task_size = std::max(n / (4 * static_cast<size_t>(omp_get_max_threads())), static_cast<size_t>(10000));
+
+    std::vector<BisectNode> nodes = {{0, n, 1.0}};
+    while (nodes.size() < static_cast<size_t>(num_clusters)) {
+        // Each round splits the clusters with the largest error, at most doubling their number
+        std::stable_sort(nodes.begin(), nodes.end(), [](const BisectNode& a, const BisectNode& b) {
+            return a.sse > b.sse;
+        });
+        size_t num_splits = std::min(static_cast<size_t>(num_clusters) - nodes.size(), nodes.size());
+        while (num_splits > 0 && nodes[num_splits - 1].sse <= 0.0) {
+            --num_splits;
+        }
+        if (num_splits == 0) {
+            break;
+        }
+
+        std::vector<BisectNode> children(2 * num_splits);
+        std::vector<char> split(num_splits);
+
+        for (size_t s = 0; s < num_splits; ++s) {
+            if (nodes[s].size >= task_size) {
+                split[s] = splitNode(points.data(), rows.data(), max_iterations, nodes[s], &children[2 * s]);
+            }
+        }
+
+        int previous_levels = omp_get_max_active_levels();
+        omp_set_max_active_levels(1);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t s = 0; s < num_splits; ++s) {
+            if (nodes[s].size < task_size) {
+                split[s] = splitNode(points.data(), rows.data(), max_iterations, nodes[s], &children[2 * s]);
+            }
+        }
+
+        omp_set_max_active_levels(previous_levels);
+
+        std::vector<BisectNode> next(nodes.begin() + num_splits, nodes.end());
+        for (size_t s = 0; s < num_splits; ++s) {
+            if (split[s]) {
+                next.push_back(children[2 * s]);
+                next.push_back(children[2 * s + 1]);
+            } else {
+                next.push_back({nodes[s].begin, nodes[s].size, 0.0});
+            }
+        }
+        nodes.swap(next);
+    }
+
+    // Leaf i becomes cluster i, centred on the mean of its points
+    std::sort(nodes.begin(), nodes.end(), [](const BisectNode& a, const BisectNode& b) {
+        return a.begin < b.begin;
+    });
+    centroids.assign(num_clusters, Centroid(0.0, 0.0, 0));
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t l = 0; l < nodes.size(); ++l) {
+        double sum_x = 0.0;
+        double sum_y = 0.0;
+        double weight = 0.0;
+        for (size_t i = nodes[l].begin; i < nodes[l].begin + nodes[l].size; ++i) {
+            sum_x += points[i].weight * points[i].x;
+            sum_y += points[i].weight * points[i].y;
+            weight += points[i].weight;
+            points[i].cluster_id = static_cast<int>(l);
+        }
+        centroids[l] = Centroid(sum_x / weight, sum_y / weight, static_cast<int>(l));
+    }
+
+    // Fewer leaves than clusters only if there are fewer distinct points: the extra centroids stay empty
+    for (size_t c = nodes.size(); c < static_cast<size_t>(num_clusters); ++c) {
+        centroids[c] = Centroid(centroids[0].x, centroids[0].y, static_cast<int>(c));
+    }
+
+    // Put the points back in dataset order by following the permutation cycles
+    for (size_t i = 0; i < n; ++i) {
+        while (rows[i] != i) {
+            size_t j = rows[i];
+            std::swap(points[i], points[j]);
+            std::swap(rows[i], rows[j]);
+        }
+    }
+}
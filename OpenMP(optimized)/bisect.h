@@ -0,0 +1,13 @@
+#ifndef BISECT_H
+#define BISECT_H
+
+#include <vector>
+#include "point.h"
+#include "centroid.h"
+
+// Bisecting k-means: splits the points top-down with 2-means runs on each cluster's own points
+// until there are num_clusters leaves. Points are partitioned in place while splitting and put
+// back in their original order before returning, labelled with their leaf id.
+void runBisecting(std::vector<Point>& points, std::vector<Centroid>& centroids, int num_clusters, int max_iterations);
+
+#endif
@@ -2,7 +2,7 @@
 #define CENTROID_H
 
 struct Centroid {
-    double x, y;            /
+    double x, y;
     double previous_x, previous_y;
     int id;
     
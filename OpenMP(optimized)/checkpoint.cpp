@@ -0,0 +1,192 @@
+#include "checkpoint.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+
+// Loads centroids from a "x,y" file, ids follow the order of the lines
+bool loadCentroids(const std::string& filepath, std::vector<Centroid>& centroids) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening centroid file: " << filepath << std::endl;
+        return false;
+    }
+
+    std::string line;
+
+    // Skip the header
+    if (std::getline(file, line)) {}
+
+    centroids.clear();
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        const char* line_cstr = line.c_str();
+        char* end_ptr;
+
+        double x = std::strtod(line_cstr, &end_ptr);
+        if (end_ptr == line_cstr || *end_ptr != ',') {
+            std::cerr << "Invalid centroid line in " << filepath << ": " << line << std::endl;
+            return false;
+        }
+        const char* y_cstr = end_ptr + 1;
+        double y = std::strtod(y_cstr, &end_ptr);
+        if (end_ptr == y_cstr) {
+            std::cerr << "Invalid centroid line in " << filepath << ": " << line << std::endl;
+            return false;
+        }
+        centroids.emplace_back(x, y, static_cast<int>(centroids.size()));
+    }
+
+    if (centroids.empty()) {
+        std::cerr << "Centroid file " << filepath << " has no centroids" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool saveCentroids(const std::string& filepath, const std::vector<Centroid>& centroids) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening centroid file: " << filepath << std::endl;
+        return false;
+    }
+
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+    file << "x,y\n";
+    for (const auto& centroid : centroids) {
+        file << centroid.x << ',' << centroid.y << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+// Loads one label per point; the file must cover exactly the loaded subset
+bool loadLabels(const std::string& filepath, std::vector<Point>& points, int num_clusters) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening label file: " << filepath << std::endl;
+        return false;
+    }
+
+    std::string line;
+
+    // Skip the header
+    if (std::getline(file, line)) {}
+
+    size_t count = 0;
+    while (std::getline(file, line)) {
+        if (count == points.size()) {
+            // Only blank lines may follow the last point
+            if (line.find_first_not_of(" \r") != std::string::npos) {
+                std::cerr << "Label file " << filepath << " has more rows than the " << points.size() << " loaded points" << std::endl;
+                return false;
+            }
+            continue;
+        }
+        const char* line_cstr = line.c_str();
+        char* end_ptr;
+        long label = std::strtol(line_cstr, &end_ptr, 10);
+        while (*end_ptr == ' ' || *end_ptr == '\r') {
+            ++end_ptr;
+        }
+        if (end_ptr == line_cstr || *end_ptr != '\0') {
+            std::cerr << "Invalid label at row " << count << " in " << filepath << ": " << line << std::endl;
+            return false;
+        }
+        if (label < 0 || label >= num_clusters) {
+            std::cerr << "Label out of range at row " << count << ": " << line << std::endl;
+            return false;
+        }
+        points[count].cluster_id = static_cast<int>(label);
+        ++count;
+    }
+
+    if (count != points.size()) {
+        std::cerr << "Label file " << filepath << " has " << count << " rows, expected " << points.size() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool saveLabels(const std::string& filepath, const std::vector<Point>& points) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening label file: " << filepath << std::endl;
+        return false;
+    }
+
+    file << "cluster_id\n";
+    for (const auto& point : points) {
+        file << point.cluster_id << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+// Writes to a temporary file and renames it, so an interrupted run never leaves a truncated checkpoint
+bool saveCheckpoint(const std::string& filepath, int iteration, const std::vector<Centroid>& centroids) {
+    std::string tmp_path = filepath + ".tmp";
+    {
+        std::ofstream file(tmp_path);
+        if (!file.is_open()) {
+            std::cerr << "Error opening checkpoint file: " << tmp_path << std::endl;
+            return false;
+        }
+
+        file << std::setprecision(std::numeric_limits<double>::max_digits10);
+        file << "iteration " << iteration << '\n';
+        file << "clusters " << centroids.size() << '\n';
+        for (const auto& centroid : centroids) {
+            file << centroid.x << ' ' << centroid.y << ' '
+                 << centroid.previous_x << ' ' << centroid.previous_y << '\n';
+        }
+        if (!file) {
+            std::cerr << "Error writing checkpoint file: " << tmp_path << std::endl;
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), filepath.c_str()) != 0) {
+        std::cerr << "Error replacing checkpoint file: " << filepath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(const std::string& filepath, int& iteration, std::vector<Centroid>& centroids) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening checkpoint file: " << filepath << std::endl;
+        return false;
+    }
+
+    std::string key;
+    int saved_iteration = 0;
+    size_t num_clusters = 0;
+    if (!(file >> key >> saved_iteration) || key != "iteration" ||
+        !(file >> key >> num_clusters) || key != "clusters") {
+        std::cerr << "Invalid checkpoint header in " << filepath << std::endl;
+        return false;
+    }
+    if (num_clusters == 0 || saved_iteration < 0) {
+        std::cerr << "Invalid checkpoint " << filepath << ": " << num_clusters << " centroids at iteration " << saved_iteration << std::endl;
+        return false;
+    }
+
+    centroids.clear();
+    centroids.reserve(num_clusters);
+    for (size_t c = 0; c < num_clusters; ++c) {
+        double x, y, previous_x, previous_y;
+        if (!(file >> x >> y >> previous_x >> previous_y)) {
+            std::cerr << "Truncated checkpoint " << filepath << ": " << c << " of " << num_clusters << " centroids" << std::endl;
+            return false;
+        }
+        centroids.emplace_back(x, y, static_cast<int>(c));
+        centroids.back().previous_x = previous_x;
+        centroids.back().previous_y = previous_y;
+    }
+    iteration = saved_iteration;
+    return true;
+}
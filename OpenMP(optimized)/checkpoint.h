@@ -0,0 +1,22 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <vector>
+#include <string>
+#include "point.h"
+#include "centroid.h"
+
+// Centroid files: header line followed by one "x,y" line per centroid
+bool loadCentroids(const std::string& filepath, std::vector<Centroid>& centroids);
+bool saveCentroids(const std::string& filepath, const std::vector<Centroid>& centroids);
+
+// Label files: header line followed by one cluster id per point, in dataset order
+bool loadLabels(const std::string& filepath, std::vector<Point>& points, int num_clusters);
+bool saveLabels(const std::string& filepath, const std::vector<Point>& points);
+
+// Iteration state of a run: completed iterations and current/previous centroid positions.
+// Labels are not stored, the next assignment step recomputes them from the centroids.
+bool saveCheckpoint(const std::string& filepath, int iteration, const std::vector<Centroid>& centroids);
+bool loadCheckpoint(const std::string& filepath, int& iteration, std::vector<Centroid>& centroids);
+
+#endif
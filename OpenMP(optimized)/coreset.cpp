@@ -0,0 +1,125 @@
+#include "coreset.h"
+#include <algorithm>
+#include <cstdint>
+#include <omp.h>
+
+// Points per block of the sampling passes. The blocks do not depend on the number of threads,
+// so neither do the prefix sums nor the coreset.
+static const size_t BLOCK_SIZE = 65536;
+
+// Uniform number in [0, 1) that depends only on the seed and the draw index (splitmix64)
+static double uniformForIndex(unsigned int seed, size_t index) {
+    uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ (index + 0x9E3779B97F4A7C15ULL * (index + 1));
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Sampling distribution q of the lightweight coreset
+static double samplingProbability(const Point& point, double mean_x, double mean_y, double total_weight, double mean_cost) {
+    double q = 0.5 * point.weight / total_weight;
+    if (mean_cost > 0.0) {
+        double dx = point.x - mean_x;
+        double dy = point.y - mean_y;
+        q += 0.5 * point.weight * (dx * dx + dy * dy) / mean_cost;
+    } else {
+        q *= 2.0;
+    }
+    return q;
+}
+
+std::vector<Point> buildCoreset(const std::vector<Point>& points, size_t coreset_size, unsigned int seed, double& mean_cost) {
+    size_t n = points.size();
+    std::vector<Point> coreset;
+    if (n == 0 || coreset_size == 0) {
+        mean_cost = 0.0;
+        return coreset;
+    }
+
+    // First pass: weighted moments, relative to the first point to limit cancellation
+    double origin_x = points[0].x;
+    double origin_y = points[0].y;
+    double total_weight = 0.0, sum_x = 0.0, sum_y = 0.0, sum_sq = 0.0;
+
+    #pragma omp parallel for schedule(static) reduction(+:total_weight, sum_x, sum_y, sum_sq)
+    for (size_t i = 0; i < n; ++i) {
+        double dx = points[i].x - origin_x;
+        double dy = points[i].y - origin_y;
+        total_weight += points[i].weight;
+        sum_x += points[i].weight * dx;
+        sum_y += points[i].weight * dy;
+        sum_sq += points[i].weight * (dx * dx + dy * dy);
+    }
+
+    double mean_dx = sum_x / total_weight;
+    double mean_dy = sum_y / total_weight;
+    double mean_x = origin_x + mean_dx;
+    double mean_y = origin_y + mean_dy;
+    mean_cost = std::max(sum_sq - total_weight * (mean_dx * mean_dx + mean_dy * mean_dy), 0.0);
+
+    // Second pass: total of q per block, then the offset of every block in the cumulative distribution
+    size_t num_blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<double> block_offsets(num_blocks + 1, 0.0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < num_blocks; ++b) {
+        size_t end = std::min(n, (b + 1) * BLOCK_SIZE);
+        double sum = 0.0;
+        for (size_t i = b * BLOCK_SIZE; i < end; ++i) {
+            sum += samplingProbability(points[i], mean_x, mean_y, total_weight, mean_cost);
+        }
+        block_offsets[b + 1] = sum;
+    }
+    for (size_t b = 0; b < num_blocks; ++b) {
+        block_offsets[b + 1] += block_offsets[b];
+    }
+
+    // m i.i.d. draws from q, sorted so that each block reads a contiguous range of them
+    size_t m = coreset_size;
+    double total_q = block_offsets[num_blocks];
+    std::vector<double> draws(m);
+    for (size_t j = 0; j < m; ++j) {
+        draws[j] = total_q * uniformForIndex(seed, j);
+    }
+    std::sort(draws.begin(), draws.end());
+
+    // Third pass: walk the cumulative distribution of each block alongside its draws. A point drawn
+    // c times is kept once with weight c * w_i / (m * q_i).
+    std::vector<std::vector<Point>> block_samples(num_blocks);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < num_blocks; ++b) {
+        size_t begin = b * BLOCK_SIZE;
+        size_t end = std::min(n, begin + BLOCK_SIZE);
+        size_t next_draw = std::lower_bound(draws.begin(), draws.end(), block_offsets[b]) - draws.begin();
+        size_t last_draw = b + 1 == num_blocks ? m
+                           : std::lower_bound(draws.begin(), draws.end(), block_offsets[b + 1]) - draws.begin();
+        if (next_draw == last_draw) {
+            continue;
+        }
+
+        double cumulative = block_offsets[b];
+        for (size_t i = begin; i < end && next_draw < last_draw; ++i) {
+            double q = samplingProbability(points[i], mean_x, mean_y, total_weight, mean_cost);
+            cumulative += q;
+
+            // The last point of a block takes whatever rounding left over
+            size_t count = 0;
+            while (next_draw < last_draw && (i + 1 == end || draws[next_draw] < cumulative)) {
+                count++;
+                next_draw++;
+            }
+            if (count > 0) {
+                block_samples[b].push_back(points[i]);
+                block_samples[b].back().weight = count * points[i].weight / (m * q);
+                block_samples[b].back().cluster_id = -1;
+            }
+        }
+    }
+
+    for (const auto& samples : block_samples) {
+        coreset.insert(coreset.end(), samples.begin(), samples.end());
+    }
+    return coreset;
+}
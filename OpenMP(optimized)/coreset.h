@@ -0,0 +1,18 @@
+#ifndef CORESET_H
+#define CORESET_H
+
+#include <vector>
+#include <cstddef>
+#include "point.h"
+
+// Lightweight coreset (Bachem, Lucic, Krause, KDD 2018) built in three parallel passes over the points.
+// m = coreset_size points are drawn i.i.d. from
+//     q_i = 1/2 * w_i / W + 1/2 * w_i * d(x_i, mu)^2 / cost(P, mu)
+// where mu is the weighted mean, and each draw gets weight w_i / (m * q_i); a point drawn several times is
+// kept once with the summed weight, so the coreset has at most m points. With m = O((d k log k + log(1/delta)) / eps^2),
+// with probability 1 - delta every set Q of k centroids satisfies
+//     |cost(P, Q) - cost(C, Q)| <= eps/2 * cost(P, Q) + eps/2 * cost(P, mu).
+// mean_cost receives cost(P, mu), the scale of the additive term.
+std::vector<Point> buildCoreset(const std::vector<Point>& points, size_t coreset_size, unsigned int seed, double& mean_cost);
+
+#endif
@@ -0,0 +1,73 @@
+#include "dedup.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <parallel/algorithm>
+#include <omp.h>
+
+// Coordinates of one input row, sorted so that duplicates become neighbours
+struct KeyedRow {
+    double x, y;
+    int row;
+};
+
+std::vector<Point> compressDuplicates(const std::vector<Point>& points, std::vector<int>& row_to_unique) {
+    int n = static_cast<int>(points.size());
+    std::vector<KeyedRow> keys(n);
+    int nan_rows = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:nan_rows)
+    for (int i = 0; i < n; ++i) {
+        keys[i] = {points[i].x, points[i].y, i};
+        if (std::isnan(points[i].x) || std::isnan(points[i].y)) {
+            nan_rows++;
+        }
+    }
+
+    // NaN compares false with everything, which would break the ordering the sort relies on
+    if (nan_rows > 0) {
+        std::cerr << "Cannot compress duplicates: " << nan_rows << " rows have NaN coordinates." << std::endl;
+        row_to_unique.clear();
+        return std::vector<Point>();
+    }
+
+    // OpenMP parallel sort of libstdc++; ties on the row keep the first row of a group in front
+    __gnu_parallel::sort(keys.begin(), keys.end(), [](const KeyedRow& a, const KeyedRow& b) {
+        if (a.x != b.x) {
+            return a.x < b.x;
+        }
+        if (a.y != b.y) {
+            return a.y < b.y;
+        }
+        return a.row < b.row;
+    });
+
+    std::vector<Point> unique_points;
+    row_to_unique.resize(n);
+    for (int k = 0; k < n; ++k) {
+        const Point& point = points[keys[k].row];
+        if (k == 0 || keys[k].x != keys[k - 1].x || keys[k].y != keys[k - 1].y) {
+            // A group keeps the label of its first row (e.g. from --init-labels)
+            unique_points.push_back(point);
+            unique_points.back().weight = 0.0;
+        }
+        unique_points.back().weight += point.weight;
+        row_to_unique[keys[k].row] = static_cast<int>(unique_points.size()) - 1;
+    }
+
+    return unique_points;
+}
+
+bool saveExpandedLabels(const std::string& filepath, const std::vector<Point>& unique_points, const std::vector<int>& row_to_unique) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening label file: " << filepath << std::endl;
+        return false;
+    }
+
+    file << "cluster_id\n";
+    for (int unique_index : row_to_unique) {
+        file << unique_points[unique_index].cluster_id << '\n';
+    }
+    return static_cast<bool>(file);
+}
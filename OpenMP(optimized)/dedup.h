@@ -0,0 +1,16 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <vector>
+#include <string>
+#include "point.h"
+
+// Merges points with identical coordinates into one point whose weight is the sum of their weights.
+// row_to_unique[r] is the index of the merged point that stands for row r of the input.
+// Returns no points if a coordinate is NaN.
+std::vector<Point> compressDuplicates(const std::vector<Point>& points, std::vector<int>& row_to_unique);
+
+// Writes one label per original row, taken from the merged point that stands for it
+bool saveExpandedLabels(const std::string& filepath, const std::vector<Point>& unique_points, const std::vector<int>& row_to_unique);
+
+#endif
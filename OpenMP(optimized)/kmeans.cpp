@@ -1,57 +1,162 @@
 #include "kmeans.h"
+#include "checkpoint.h"
 #include <cstdlib>
 #include <limits>
 #include <cmath>
 #include <iostream>
 #include <omp.h>
+#include <algorithm>
 
+// Id of the centroid nearest to a point, with the squared distance to it
+static inline int nearestCentroid(const Point& point, const std::vector<Centroid>& centroids, double& min_distance_sq) {
+    min_distance_sq = std::numeric_limits<double>::max();
+    int closest_cluster = -1;
+    for (const auto& centroid : centroids) {
+        double dx = point.x - centroid.x;
+        double dy = point.y - centroid.y;
+        double dist_sq = dx * dx + dy * dy;
+        if (dist_sq < min_distance_sq) {
+            min_distance_sq = dist_sq;
+            closest_cluster = centroid.id;
+        }
+    }
+    return closest_cluster;
+}
+
+// Squared distance from a point to its nearest centroid
+static double nearestDistanceSq(const Point& point, const std::vector<Centroid>& centroids) {
+    double min_distance_sq;
+    nearestCentroid(point, centroids, min_distance_sq);
+    return min_distance_sq;
+}
 
 KMeans::KMeans(int k, int iterations, double convThreshold)
-    : num_clusters(k), max_iterations(iterations), epsilon(convThreshold) {}
+    : num_clusters(k), max_iterations(iterations), epsilon(convThreshold),
+      start_iteration(0), checkpoint_interval(0), random(42), verbose(true),
+      max_relaxation(1.0), inertia_tolerance(0.0), reassign_tolerance(0.0), inertia(0.0), reassigned_fraction(0.0),
+      completed_iterations(0), has_converged(false) {}
 
-// Function to initialize centroids randomly
 void KMeans::initializeCentroids(std::vector<Centroid>& centroids, const std::vector<Point>& points) {
+    initializeCentroids(centroids, points.data(), points.size());
+}
+
+void KMeans::assignPointsToClusters(std::vector<Point>& points, const std::vector<Centroid>& centroids, bool measure_inertia) {
+    assignPointsToClusters(points.data(), points.size(), centroids, measure_inertia);
+}
+
+void KMeans::calculateNewCentroids(const std::vector<Point>& points, std::vector<Centroid>& centroids) {
+    calculateNewCentroids(points.data(), points.size(), centroids);
+}
+
+void KMeans::run(std::vector<Point>& points, std::vector<Centroid>& centroids) {
+    run(points.data(), points.size(), centroids);
+}
+
+double KMeans::computeInertia(const std::vector<Point>& points, const std::vector<Centroid>& centroids) {
+    return computeInertia(points.data(), points.size(), centroids);
+}
+
+// Function to initialize centroids randomly
+void KMeans::initializeCentroids(std::vector<Centroid>& centroids, const Point* points, size_t num_points) {
     centroids.reserve(num_clusters);
     for (int i = 0; i < num_clusters; ++i) {
-        int random_index = rand() % points.size();
+        int random_index = random.next() % num_points;
         centroids.emplace_back(points[random_index].x, points[random_index].y, i);
     }
 }
 
-// Assigns points to the nearest centroids
-void KMeans::assignPointsToClusters(std::vector<Point>& points, const std::vector<Centroid>& centroids) {
-    #pragma omp parallel for schedule(static) default(none) shared(points, centroids)
-    for (size_t i = 0; i < points.size(); ++i) {
-        double min_distance_sq = std::numeric_limits<double>::max();
-        int closest_cluster = -1;
-
-        for (int c = 0; c < num_clusters; ++c) {
-            double dx = points[i].x - centroids[c].x;
-            double dy = points[i].y - centroids[c].y;
-            double dist_sq = dx * dx + dy * dy;
-            if (dist_sq < min_distance_sq) {
-                min_distance_sq = dist_sq;
-                closest_cluster = centroids[c].id;
+// Warm start: seeds centroids with the means of the clusters given by existing labels
+void KMeans::initializeCentroidsFromLabels(std::vector<Centroid>& centroids, const std::vector<Point>& points) {
+    centroids.reserve(num_clusters);
+    for (int i = 0; i < num_clusters; ++i) {
+        centroids.emplace_back(0.0, 0.0, i);
+    }
+    calculateNewCentroids(points, centroids);
+}
+
+// Assigns points to the nearest centroids. The plain pass only labels the points; the inertia is measured on
+// request, and the reassigned weight and changed clusters when over-relaxation or --reassign-tol need them.
+void KMeans::assignPointsToClusters(Point* points, size_t num_points, const std::vector<Centroid>& centroids, bool measure_inertia) {
+    double total_distance_sq = 0.0;
+    bool track_changes = max_relaxation > 1.0 || reassign_tolerance > 0.0;
+
+    if (!track_changes) {
+        reassigned_fraction = 0.0;
+        cluster_changed.clear();
+
+        if (!measure_inertia) {
+            #pragma omp parallel for schedule(static) default(none) shared(points, num_points, centroids)
+            for (size_t i = 0; i < num_points; ++i) {
+                double min_distance_sq;
+                points[i].cluster_id = nearestCentroid(points[i], centroids, min_distance_sq);
             }
+            inertia = 0.0;
+            return;
+        }
+
+        #pragma omp parallel for schedule(static) default(none) shared(points, num_points, centroids) reduction(+:total_distance_sq)
+        for (size_t i = 0; i < num_points; ++i) {
+            double min_distance_sq;
+            points[i].cluster_id = nearestCentroid(points[i], centroids, min_distance_sq);
+            total_distance_sq += points[i].weight * min_distance_sq;
         }
-        points[i].cluster_id = closest_cluster;
+        inertia = total_distance_sq;
+        return;
     }
+
+    int K = num_clusters;
+    double changed = 0.0;
+    double total_weight = 0.0;
+    cluster_changed.assign(K, 0);
+
+    #pragma omp parallel default(none) shared(points, num_points, centroids, K) reduction(+:total_distance_sq, changed, total_weight)
+    {
+        // Per-thread flags, merged once after the loop
+        std::vector<char> local_changed(K, 0);
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < num_points; ++i) {
+            double min_distance_sq;
+            int closest_cluster = nearestCentroid(points[i], centroids, min_distance_sq);
+            int previous_cluster = points[i].cluster_id;
+            if (previous_cluster != closest_cluster) {
+                changed += points[i].weight;
+                local_changed[closest_cluster] = 1;
+                if (previous_cluster >= 0 && previous_cluster < K) {
+                    local_changed[previous_cluster] = 1;
+                }
+            }
+            points[i].cluster_id = closest_cluster;
+            total_distance_sq += points[i].weight * min_distance_sq;
+            total_weight += points[i].weight;
+        }
+
+        #pragma omp critical
+        {
+            for (int c = 0; c < K; ++c) {
+                cluster_changed[c] |= local_changed[c];
+            }
+        }
+    }
+
+    inertia = total_distance_sq;
+    reassigned_fraction = total_weight > 0.0 ? changed / total_weight : 0.0;
 }
 
 // Calculates new centroids by optimizing the reduction
-void KMeans::calculateNewCentroids(const std::vector<Point>& points, std::vector<Centroid>& centroids) {
+void KMeans::calculateNewCentroids(const Point* points, size_t num_points, std::vector<Centroid>& centroids) {
     int K = num_clusters;
 
     // Initializes arrays for manual reduction
     double sumX[K];
     double sumY[K];
-    int counts[K];
+    double weights[K];
 
     // Initialize values to 0
     for (int i = 0; i < K; ++i) {
         sumX[i] = 0.0;
         sumY[i] = 0.0;
-        counts[i] = 0;
+        weights[i] = 0.0;
     }
 
     #pragma omp parallel
@@ -59,15 +164,15 @@ void KMeans::calculateNewCentroids(const std::vector<Point>& points, std::vector
         // Local variables for reduction
         double local_sumX[K] = {0.0};
         double local_sumY[K] = {0.0};
-        int local_counts[K] = {0};
+        double local_weights[K] = {0.0};
 
         // Parallel cycle with manual reduction
         #pragma omp for schedule(static)
-        for (size_t i = 0; i < points.size(); ++i) {
+        for (size_t i = 0; i < num_points; ++i) {
             int cluster_id = points[i].cluster_id;
-            local_sumX[cluster_id] += points[i].x;
-            local_sumY[cluster_id] += points[i].y;
-            local_counts[cluster_id] += 1;
+            local_sumX[cluster_id] += points[i].weight * points[i].x;
+            local_sumY[cluster_id] += points[i].weight * points[i].y;
+            local_weights[cluster_id] += points[i].weight;
         }
 
         // Manual reduction out of parallel cycle
@@ -76,53 +181,175 @@ void KMeans::calculateNewCentroids(const std::vector<Point>& points, std::vector
             for (int j = 0; j < K; ++j) {
                 sumX[j] += local_sumX[j];
                 sumY[j] += local_sumY[j];
-                counts[j] += local_counts[j];
+                weights[j] += local_weights[j];
             }
         }
     }
 
     // Update coordinates of centroids
     for (int j = 0; j < K; ++j) {
-        if (counts[j] > 0) {
-            centroids[j].updateCoordinates(sumX[j] / counts[j], sumY[j] / counts[j]);
+        if (weights[j] > 0.0) {
+            centroids[j].updateCoordinates(sumX[j] / weights[j], sumY[j] / weights[j]);
         } else {
             // If a cluster has no points, reassign a random centroid
-            int random_index = rand() % points.size();
+            int random_index = random.next() % num_points;
             centroids[j].updateCoordinates(points[random_index].x, points[random_index].y);
         }
     }
 }
 
 
-void KMeans::run(std::vector<Point>& points, std::vector<Centroid>& centroids) {
-    initializeCentroids(centroids, points);
+// Runs Lloyd iterations; centroids already present (warm start or checkpoint) are used as the starting point
+void KMeans::run(Point* points, size_t num_points, std::vector<Centroid>& centroids) {
+    if (centroids.empty()) {
+        initializeCentroids(centroids, points, num_points);
+    } else if (verbose) {
+        std::cout << "Warm start from " << centroids.size() << " centroids at iteration " << start_iteration << "." << std::endl;
+    }
 
     bool converged = false;
-    int iteration = 0;
+    int iteration = start_iteration;
+
+    // Safeguarded over-relaxation: the Lloyd step is stretched by alpha while the objective keeps
+    // decreasing, and the plain Lloyd centroids are restored as soon as it does not. A cluster whose
+    // points did not change is already moved exactly onto its mean, so only the others are stretched.
+    double alpha = 1.0;             // Factor for the next step
+    double applied_alpha = 1.0;     // Factor of the step that produced the current centroids
+    double previous_inertia = std::numeric_limits<double>::max();
+    std::vector<Centroid> lloyd_centroids;
+    int rejected_steps = 0;
+    int last_checkpoint = start_iteration;
 
     while (iteration < max_iterations && !converged) {
-        assignPointsToClusters(points, centroids);
-        calculateNewCentroids(points, centroids);
+        assignPointsToClusters(points, num_points, centroids, max_relaxation > 1.0 || inertia_tolerance > 0.0);
+
+        // A rejected step still cost an assignment pass, so it counts as an iteration
+        if (applied_alpha > 1.0 && inertia >= previous_inertia) {
+            centroids = lloyd_centroids;
+            alpha = 1.0;
+            applied_alpha = 1.0;
+            rejected_steps++;
+            iteration++;
+            continue;
+        }
+
+        bool inertia_settled = iteration > start_iteration &&
+                               std::fabs(previous_inertia - inertia) <= inertia_tolerance * previous_inertia;
+        previous_inertia = inertia;
+
+        calculateNewCentroids(points, num_points, centroids);
+
+        applied_alpha = 1.0;
+        if (max_relaxation > 1.0 && reassigned_fraction > 0.0) {
+            lloyd_centroids = centroids;
+            for (auto& centroid : centroids) {
+                if (!cluster_changed[centroid.id]) {
+                    continue;
+                }
+                centroid.x = centroid.previous_x + alpha * (centroid.x - centroid.previous_x);
+                centroid.y = centroid.previous_y + alpha * (centroid.y - centroid.previous_y);
+            }
+            applied_alpha = alpha;
+            alpha = alpha >= max_relaxation ? 1.0 : std::min(alpha * 1.5, max_relaxation);
+        }
 
         // Convergence control
-        converged = true;
-        #pragma omp parallel for schedule(static) default(none) shared(converged, centroids)
-        for (int c = 0; c < num_clusters; ++c) {
-            double dx = centroids[c].x - centroids[c].previous_x;
-            double dy = centroids[c].y - centroids[c].previous_y;
-            double movement_sq = dx * dx + dy * dy;
-
-            if (movement_sq > epsilon * epsilon) {
-                #pragma omp atomic write
-                converged = false;
+        converged = (inertia_tolerance > 0.0 && inertia_settled) ||
+                    reassigned_fraction < reassign_tolerance;
+        if (!converged) {
+            converged = true;
+            #pragma omp parallel for schedule(static) default(none) shared(converged, centroids)
+            for (int c = 0; c < num_clusters; ++c) {
+                double dx = centroids[c].x - centroids[c].previous_x;
+                double dy = centroids[c].y - centroids[c].previous_y;
+                double movement_sq = dx * dx + dy * dy;
+
+                if (movement_sq > epsilon * epsilon) {
+                    #pragma omp atomic write
+                    converged = false;
+                }
             }
         }
         iteration++;
+
+        if (checkpoint_interval > 0 && !converged && iteration - last_checkpoint >= checkpoint_interval) {
+            saveCheckpoint(checkpoint_path, iteration, centroids);
+            last_checkpoint = iteration;
+        }
     }
 
+    completed_iterations = iteration;
+    has_converged = converged;
+
+    if (!verbose) {
+        return;
+    }
+    if (max_relaxation > 1.0) {
+        std::cout << "Over-relaxed steps rejected: " << rejected_steps << "." << std::endl;
+    }
     if (converged) {
         std::cout << "Convergence achieved after " << iteration << " iterations." << std::endl;
     } else {
         std::cout << "Reached the maximum number of iterations without convergence." << std::endl;
     }
 }
+
+// Sum of squared distances from each point to the centroid it is assigned to
+double KMeans::computeInertia(const Point* points, size_t num_points, const std::vector<Centroid>& centroids) {
+    double inertia = 0.0;
+
+    #pragma omp parallel for schedule(static) reduction(+:inertia) default(none) shared(points, num_points, centroids)
+    for (size_t i = 0; i < num_points; ++i) {
+        const Centroid& centroid = centroids[points[i].cluster_id];
+        double dx = points[i].x - centroid.x;
+        double dy = points[i].y - centroid.y;
+        inertia += points[i].weight * (dx * dx + dy * dy);
+    }
+    return inertia;
+}
+
+// k-means++ augmentation: adds one centroid at a point drawn with probability
+// proportional to its squared distance from the nearest existing centroid
+void KMeans::addCentroid(std::vector<Centroid>& centroids, const std::vector<Point>& points) {
+    size_t n = points.size();
+    int num_chunks = omp_get_max_threads();
+    size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+    std::vector<double> chunk_sums(num_chunks, 0.0);
+
+    // Per-chunk totals in parallel, the draw then only rescans one chunk
+    #pragma omp parallel for schedule(static) default(none) shared(points, centroids, chunk_sums, n, num_chunks, chunk_size)
+    for (int t = 0; t < num_chunks; ++t) {
+        size_t end = std::min(n, (t + 1) * chunk_size);
+        double sum = 0.0;
+        for (size_t i = t * chunk_size; i < end; ++i) {
+            sum += points[i].weight * nearestDistanceSq(points[i], centroids);
+        }
+        chunk_sums[t] = sum;
+    }
+
+    double total = 0.0;
+    for (int t = 0; t < num_chunks; ++t) {
+        total += chunk_sums[t];
+    }
+
+    size_t chosen = random.next() % n;
+    if (total > 0.0) {
+        double target = total * (random.next() / (RAND_MAX + 1.0));
+        int t = 0;
+        while (t < num_chunks - 1 && target >= chunk_sums[t]) {
+            target -= chunk_sums[t];
+            ++t;
+        }
+        size_t end = std::min(n, (t + 1) * chunk_size);
+        for (size_t i = t * chunk_size; i < end; ++i) {
+            chosen = i;
+            target -= points[i].weight * nearestDistanceSq(points[i], centroids);
+            if (target < 0.0) {
+                break;
+            }
+        }
+    }
+
+    centroids.emplace_back(points[chosen].x, points[chosen].y, static_cast<int>(centroids.size()));
+    num_clusters = static_cast<int>(centroids.size());
+}
@@ -5,6 +5,7 @@
 #include <string>
 #include "point.h"
 #include "centroid.h"
+#include "random.h"
 
 // Function to load a subset of the dataset
 std::vector<Point> loadSubset(const std::string& filepath, int subset_size);
@@ -14,13 +15,38 @@ public:
     int num_clusters;       // Number of clusters
     int max_iterations;     // Maximum number of iterations
     double epsilon;         // Convergence threshold
+    int start_iteration;    // Iterations already done when resuming from a checkpoint
+    int checkpoint_interval;        // Iterations between checkpoints (0 disables checkpointing)
+    std::string checkpoint_path;    // File where the iteration state is saved
+    RandomGenerator random; // Per-instance random state, so several instances can run concurrently
+    bool verbose;           // Print warm start and convergence messages
+    double max_relaxation;          // Largest over-relaxation factor of the centroid update (1 = plain Lloyd)
+    double inertia_tolerance;       // Stop when the relative inertia change falls below this (0 disables)
+    double reassign_tolerance;      // Stop when the fraction of reassigned points falls below this (0 disables)
+    double inertia;                 // Weighted objective measured by the last assignment step (0 when not measured)
+    double reassigned_fraction;     // Share of the point weight that changed cluster in the last assignment step
+    std::vector<char> cluster_changed;      // Clusters that gained or lost points in the last assignment step
+                                            // (both only tracked when max_relaxation > 1 or reassign_tolerance > 0)
+    int completed_iterations;       // Iterations done by the last call to run
+    bool has_converged;             // Whether the last call to run converged
 
     KMeans(int k, int iterations, double convThreshold = 0.001);
 
     void initializeCentroids(std::vector<Centroid>& centroids, const std::vector<Point>& points);
-    void assignPointsToClusters(std::vector<Point>& points, const std::vector<Centroid>& centroids);
+    void initializeCentroidsFromLabels(std::vector<Centroid>& centroids, const std::vector<Point>& points);
+    void assignPointsToClusters(std::vector<Point>& points, const std::vector<Centroid>& centroids, bool measure_inertia = false);
     void calculateNewCentroids(const std::vector<Point>& points, std::vector<Centroid>& centroids);
     void run(std::vector<Point>& points, std::vector<Centroid>& centroids);
+
+    // Same kernels on a contiguous range of points, e.g. one cluster of a partitioned array
+    void initializeCentroids(std::vector<Centroid>& centroids, const Point* points, size_t num_points);
+    void assignPointsToClusters(Point* points, size_t num_points, const std::vector<Centroid>& centroids, bool measure_inertia = false);
+    void calculateNewCentroids(const Point* points, size_t num_points, std::vector<Centroid>& centroids);
+    void run(Point* points, size_t num_points, std::vector<Centroid>& centroids);
+
+    double computeInertia(const std::vector<Point>& points, const std::vector<Centroid>& centroids);
+    double computeInertia(const Point* points, size_t num_points, const std::vector<Centroid>& centroids);
+    void addCentroid(std::vector<Centroid>& centroids, const std::vector<Point>& points);
 };
 
 #endif
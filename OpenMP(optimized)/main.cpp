@@ -1,4 +1,11 @@
 #include "kmeans.h"
+#include "checkpoint.h"
+#include "batch.h"
+#include "sweep.h"
+#include "bisect.h"
+#include "dedup.h"
+#include "coreset.h"
+#include "stream.h"
 #include <iostream>
 #include <vector>
 #include <fstream>
@@ -66,9 +73,56 @@ std::vector<Point> loadSubset(const std::string& filepath, int subset_size) {
     return points;
 }
 
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <dataset_path> <num_clusters> <iterations> <subset_size> [options]" << std::endl;
+    std::cerr << "       " << program << " --batch <manifest> [big_job_size]" << std::endl;
+    std::cerr << "       " << program << " --stream <num_clusters> [batch_size] [max_latency_ms] [decay] < points.csv" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --init-centroids <file>    warm start from the centroids in <file>" << std::endl;
+    std::cerr << "  --init-labels <file>       warm start from the cluster means of the labels in <file>" << std::endl;
+    std::cerr << "  --checkpoint <file>        file where the iteration state is saved (needs --checkpoint-every)" << std::endl;
+    std::cerr << "  --checkpoint-every <n>     save a checkpoint every <n> iterations" << std::endl;
+    std::cerr << "  --resume <file>            resume an interrupted run from a checkpoint" << std::endl;
+    std::cerr << "  --save-centroids <file>    write the final centroids to <file>" << std::endl;
+    std::cerr << "  --save-labels <file>       write the final labels to <file>" << std::endl;
+    std::cerr << "  --sweep <k_max>            cluster for every K from num_clusters to k_max and report the elbow" << std::endl;
+    std::cerr << "  --silhouette-samples <n>   points sampled for the silhouette score in a sweep (default 2000)" << std::endl;
+    std::cerr << "  --accelerate <max_step>    over-relax the centroid update up to <max_step> times the Lloyd step (e.g. 2)" << std::endl;
+    std::cerr << "  --inertia-tol <tol>        stop when the relative inertia change falls below <tol>" << std::endl;
+    std::cerr << "  --reassign-tol <fraction>  stop when fewer than <fraction> of the points change cluster" << std::endl;
+    std::cerr << "  --dedup <0|1>              merge duplicate coordinates into weighted points before clustering" << std::endl;
+    std::cerr << "  --coreset <m>              cluster a weighted coreset of at most <m> points, then label every point" << std::endl;
+    std::cerr << "  --bisect <n>               bisecting k-means, followed by at most <n> flat iterations (0 to skip)" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 5) {
-        std::cerr << "Usage: " << argv[0] << " <dataset_path> <num_clusters> <iterations> <subset_size>" << std::endl;
+    // Batch mode: many independent jobs listed in a manifest
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        int big_job_size = argc >= 4 ? std::stoi(argv[3]) : 1000000;
+        std::vector<BatchJob> jobs;
+        if (!loadManifest(argv[2], jobs)) {
+            return 1;
+        }
+        runBatch(jobs, big_job_size);
+        return 0;
+    }
+
+    // Streaming mode: online clustering of the points read from stdin
+    if (argc >= 3 && std::string(argv[1]) == "--stream") {
+        int num_clusters = std::stoi(argv[2]);
+        int batch_size = argc >= 4 ? std::stoi(argv[3]) : 1000;
+        int max_latency_ms = argc >= 5 ? std::stoi(argv[4]) : 100;
+        double decay = argc >= 6 ? std::stod(argv[5]) : 1.0;
+        if (num_clusters <= 0 || batch_size <= 0 || max_latency_ms < 0 || decay <= 0.0 || decay > 1.0) {
+            std::cerr << "Error: --stream needs num_clusters > 0, batch_size > 0, max_latency_ms >= 0 and 0 < decay <= 1." << std::endl;
+            return 1;
+        }
+        runStream(num_clusters, batch_size, max_latency_ms, decay);
+        return 0;
+    }
+
+    if (argc < 5 || (argc - 5) % 2 != 0) {
+        printUsage(argv[0]);
         return 1;
     }
 
@@ -77,7 +131,84 @@ int main(int argc, char* argv[]) {
     int max_iterations = std::stoi(argv[3]);
     int subset_size = std::stoi(argv[4]);
 
-    std::srand(42);  // Seed per la generazione casuale
+    KMeans kmeans(num_clusters, max_iterations);
+    std::string init_centroids_path, init_labels_path, resume_path;
+    std::string save_centroids_path, save_labels_path;
+    int sweep_max = 0;
+    int silhouette_samples = 2000;
+    int bisect_refine = -1;
+    bool dedup = false;
+    int coreset_size = 0;
+
+    // Optional arguments come in "--option value" pairs
+    for (int i = 5; i < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--init-centroids") {
+            init_centroids_path = value;
+        } else if (option == "--init-labels") {
+            init_labels_path = value;
+        } else if (option == "--checkpoint") {
+            kmeans.checkpoint_path = value;
+        } else if (option == "--checkpoint-every") {
+            kmeans.checkpoint_interval = std::stoi(value);
+        } else if (option == "--resume") {
+            resume_path = value;
+        } else if (option == "--save-centroids") {
+            save_centroids_path = value;
+        } else if (option == "--save-labels") {
+            save_labels_path = value;
+        } else if (option == "--sweep") {
+            sweep_max = std::stoi(value);
+        } else if (option == "--silhouette-samples") {
+            silhouette_samples = std::stoi(value);
+        } else if (option == "--accelerate") {
+            kmeans.max_relaxation = std::stod(value);
+        } else if (option == "--inertia-tol") {
+            kmeans.inertia_tolerance = std::stod(value);
+        } else if (option == "--reassign-tol") {
+            kmeans.reassign_tolerance = std::stod(value);
+        } else if (option == "--dedup") {
+            dedup = std::stoi(value) != 0;
+        } else if (option == "--coreset") {
+            coreset_size = std::stoi(value);
+        } else if (option == "--bisect") {
+            bisect_refine = std::stoi(value);
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (kmeans.checkpoint_interval > 0 && kmeans.checkpoint_path.empty()) {
+        std::cerr << "--checkpoint-every requires --checkpoint <file>." << std::endl;
+        return 1;
+    }
+    if (!kmeans.checkpoint_path.empty() && kmeans.checkpoint_interval <= 0) {
+        std::cerr << "--checkpoint requires --checkpoint-every <n>." << std::endl;
+        return 1;
+    }
+    if (sweep_max > 0 && sweep_max < num_clusters) {
+        std::cerr << "--sweep needs k_max >= num_clusters." << std::endl;
+        return 1;
+    }
+    if (silhouette_samples < 2) {
+        std::cerr << "--silhouette-samples needs at least 2 samples." << std::endl;
+        return 1;
+    }
+    if (sweep_max > 0 && bisect_refine >= 0) {
+        std::cerr << "--sweep cannot be combined with --bisect." << std::endl;
+        return 1;
+    }
+    if (coreset_size > 0 && (sweep_max > 0 || bisect_refine >= 0)) {
+        std::cerr << "--coreset cannot be combined with --sweep or --bisect." << std::endl;
+        return 1;
+    }
+    if (coreset_size != 0 && coreset_size < num_clusters) {
+        std::cerr << "--coreset needs at least num_clusters points." << std::endl;
+        return 1;
+    }
 
     // Start timer for loading data
     auto load_start = std::chrono::high_resolution_clock::now();
@@ -91,15 +222,95 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Starting state: a checkpoint wins over centroids, which win over labels
     std::vector<Centroid> centroids;
-    KMeans kmeans(num_clusters, max_iterations);
+    if (!resume_path.empty()) {
+        if (!loadCheckpoint(resume_path, kmeans.start_iteration, centroids)) {
+            return 1;
+        }
+    } else if (!init_centroids_path.empty()) {
+        if (!loadCentroids(init_centroids_path, centroids)) {
+            return 1;
+        }
+    } else if (!init_labels_path.empty()) {
+        if (!loadLabels(init_labels_path, points, num_clusters)) {
+            return 1;
+        }
+        kmeans.initializeCentroidsFromLabels(centroids, points);
+    }
+
+    // Duplicate rows become one weighted point; labels are mapped back to the rows at output
+    std::vector<int> row_to_unique;
+    if (dedup) {
+        auto dedup_start = std::chrono::high_resolution_clock::now();
+        std::vector<Point> unique_points = compressDuplicates(points, row_to_unique);
+        if (unique_points.empty()) {
+            return 1;
+        }
+        points.swap(unique_points);
+        std::vector<Point>().swap(unique_points);
+        auto dedup_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> dedup_duration = dedup_end - dedup_start;
+        std::cout << "Compressed " << row_to_unique.size() << " rows into " << points.size()
+                  << " weighted points in " << dedup_duration.count() << " seconds." << std::endl;
+    }
+
+    if (bisect_refine >= 0 && (!centroids.empty() || static_cast<size_t>(num_clusters) > points.size())) {
+        std::cerr << "--bisect needs no initial state and at least num_clusters points." << std::endl;
+        return 1;
+    }
+    if (!centroids.empty() && static_cast<int>(centroids.size()) != num_clusters) {
+        std::cerr << "Initial state has " << centroids.size() << " centroids, expected " << num_clusters << "." << std::endl;
+        return 1;
+    }
 
     // Start timer for computation
     auto compute_start = std::chrono::high_resolution_clock::now();
-    kmeans.run(points, centroids);
+    if (sweep_max > 0) {
+        runSweep(kmeans, points, centroids, sweep_max, silhouette_samples);
+    } else if (bisect_refine >= 0) {
+        runBisecting(points, centroids, num_clusters, max_iterations);
+        std::cout << "Bisecting k-means inertia: " << kmeans.computeInertia(points, centroids) << std::endl;
+        if (bisect_refine > 0) {
+            kmeans.max_iterations = bisect_refine;
+            kmeans.run(points, centroids);
+            kmeans.assignPointsToClusters(points, centroids, true);
+            std::cout << "Refined inertia: " << kmeans.inertia << std::endl;
+        }
+    } else if (coreset_size > 0) {
+        double mean_cost = 0.0;
+        std::vector<Point> coreset = buildCoreset(points, coreset_size, kmeans.random.seed, mean_cost);
+        std::cout << "Coreset: " << coreset.size() << " weighted points out of " << points.size()
+                  << " (cost around the mean: " << mean_cost << ")." << std::endl;
+        if (coreset.size() < static_cast<size_t>(num_clusters)) {
+            std::cerr << "The coreset has fewer than " << num_clusters << " points; use a larger --coreset." << std::endl;
+            return 1;
+        }
+
+        kmeans.run(coreset, centroids);
+        kmeans.assignPointsToClusters(coreset, centroids, true);
+        double coreset_inertia = kmeans.inertia;
+
+        // One exact pass labels every point and measures the true objective
+        kmeans.assignPointsToClusters(points, centroids, true);
+        std::cout << "Coreset inertia: " << coreset_inertia << ", full inertia: " << kmeans.inertia << std::endl;
+    } else {
+        kmeans.run(points, centroids);
+    }
     auto compute_end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> compute_duration = compute_end - compute_start;
     std::cout << "Computation time: " << compute_duration.count() << " seconds." << std::endl;
 
+    if (!save_centroids_path.empty() && !saveCentroids(save_centroids_path, centroids)) {
+        return 1;
+    }
+    if (!save_labels_path.empty()) {
+        bool saved = dedup ? saveExpandedLabels(save_labels_path, points, row_to_unique)
+                           : saveLabels(save_labels_path, points);
+        if (!saved) {
+            return 1;
+        }
+    }
+
     return 0;
 }
@@ -1,3 +1,3 @@
 #include "point.h"
 
-Point::Point(double xCoord, double yCoord) : x(xCoord), y(yCoord), cluster_id(-1) {}
+Point::Point(double xCoord, double yCoord, double w) : x(xCoord), y(yCoord), weight(w), cluster_id(-1) {}
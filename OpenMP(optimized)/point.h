@@ -3,10 +3,11 @@
 
 struct Point {
     double x, y;      
+    double weight;    // Number of dataset rows the point stands for (duplicates, coreset samples)
     int cluster_id;
 
-    Point() : x(0.0), y(0.0), cluster_id(-1) {}
-    Point(double xCoord, double yCoord);
+    Point() : x(0.0), y(0.0), weight(1.0), cluster_id(-1) {}
+    Point(double xCoord, double yCoord, double w = 1.0);
 };
 
 #endif
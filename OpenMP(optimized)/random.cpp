@@ -0,0 +1,36 @@
+#include "random.h"
+
+RandomGenerator::RandomGenerator(unsigned int s) {
+    reseed(s);
+}
+
+// Mirrors glibc srandom_r for the default TYPE_3 state
+void RandomGenerator::reseed(unsigned int s) {
+    seed = s;
+    int32_t word = static_cast<int32_t>(s == 0 ? 1 : s);
+    state[0] = word;
+    for (int i = 1; i < 31; ++i) {
+        // state[i] = 16807 * state[i - 1] % 2147483647 without overflowing 31 bits
+        int32_t hi = word / 127773;
+        int32_t lo = word % 127773;
+        word = 16807 * lo - 2836 * hi;
+        if (word < 0) {
+            word += 2147483647;
+        }
+        state[i] = word;
+    }
+    front = 3;
+    rear = 0;
+    for (int i = 0; i < 310; ++i) {
+        next();
+    }
+}
+
+// Mirrors glibc random_r
+int RandomGenerator::next() {
+    uint32_t value = static_cast<uint32_t>(state[front]) + static_cast<uint32_t>(state[rear]);
+    state[front] = static_cast<int32_t>(value);
+    front = front + 1 == 31 ? 0 : front + 1;
+    rear = rear + 1 == 31 ? 0 : rear + 1;
+    return static_cast<int>(value >> 1);
+}
@@ -0,0 +1,21 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Same sequence as glibc srand(seed) followed by rand() (additive feedback generator of degree 31),
+// with the state kept in the object so that several instances can draw numbers concurrently.
+// With the default seed the optimized build picks the same starting points as the serial build only when
+// the serial build uses glibc's rand(); other C libraries (e.g. on macOS) produce a different sequence.
+struct RandomGenerator {
+    unsigned int seed;      // Seed of the current sequence
+    int32_t state[31];
+    int front, rear;
+
+    explicit RandomGenerator(unsigned int s = 42);
+
+    void reseed(unsigned int s);
+    int next();             // Next number in [0, RAND_MAX], like rand()
+};
+
+#endif
@@ -0,0 +1,215 @@
+#!/bin/bash
+
+# Strong and weak scaling of KMeans_parallel against the serial build.
+# Every configuration is run TRIALS times; load and compute times are taken from the
+# program's own timers, not from the wall time of the process.
+#
+# Usage: ./scaling_test.sh [--save-baseline]
+# Settings can be overridden from the environment, e.g. TRIALS=10 CORES="1 2 4" ./scaling_test.sh
+
+DATASET_PATH="${DATASET_PATH:-../dataset.csv}"
+PROGRAM="${PROGRAM:-./KMeans_parallel}"
+SERIAL_PROGRAM="${SERIAL_PROGRAM:-../serial/KMeans_serial}"
+
+# Number of repetitions of every configuration
+TRIALS="${TRIALS:-5}"
+
+# Strong scaling: fixed sizes, variable number of cores
+read -r -a SUBSET_SIZES <<< "${SUBSET_SIZES:-100000 1000000 10000000}"
+read -r -a CORES <<< "${CORES:-1 2 4 8 16 24}"
+
+# Weak scaling: WEAK_SIZE points per core
+WEAK_SIZE="${WEAK_SIZE:-400000}"
+
+# Number of clusters and iterations for the KMeans algorithm, plus extra options for the parallel program
+CLUSTERS="${CLUSTERS:-6}"
+ITERATIONS="${ITERATIONS:-500}"
+EXTRA_ARGS="${EXTRA_ARGS:-}"
+
+# Output files and regression check: a configuration regresses when its median compute
+# time is more than TOLERANCE (fraction) above the baseline
+CSV_FILE="${CSV_FILE:-scaling_results.csv}"
+JSON_FILE="${JSON_FILE:-scaling_results.json}"
+BASELINE_FILE="${BASELINE_FILE:-scaling_baseline.csv}"
+TOLERANCE="${TOLERANCE:-0.10}"
+
+# Verify that the programs exist
+for BINARY in "$PROGRAM" "$SERIAL_PROGRAM"; do
+    if [ ! -f "$BINARY" ]; then
+        echo "Error: the program $BINARY does not exist. Make sure it has been compiled."
+        exit 1
+    fi
+done
+
+# Runs one configuration TRIALS times and prints "load_mean compute_mean compute_std compute_min compute_median iterations"
+# Arguments: program, subset size, number of cores (0 for the serial build)
+run_trials() {
+    local program=$1 size=$2 cores=$3
+    local times=""
+    local run_iterations=""
+    for ((trial = 1; trial <= TRIALS; trial++)); do
+        local output
+        if [ "$cores" -eq 0 ]; then
+            output=$("$program" "$DATASET_PATH" "$CLUSTERS" "$ITERATIONS" "$size" 2>&1)
+        else
+            output=$(OMP_NUM_THREADS=$cores "$program" "$DATASET_PATH" "$CLUSTERS" "$ITERATIONS" "$size" $EXTRA_ARGS 2>&1)
+        fi
+        local load compute
+        load=$(echo "$output" | awk '/^Data loading time:/ { print $4 }')
+        compute=$(echo "$output" | awk '/^Computation time:/ { print $3 }')
+        if [ -z "$load" ] || [ -z "$compute" ]; then
+            echo "Error: no timings in the output of $program ($size points, $cores cores):" >&2
+            echo "$output" >&2
+            exit 1
+        fi
+
+        # Iterations actually done: the amount of work behind the compute time
+        local iterations
+        iterations=$(echo "$output" | awk -v max="$ITERATIONS" '
+            /^Convergence achieved after/ { print $4 }
+            /^Reached the maximum number of iterations/ { print max }')
+        if [ -z "$iterations" ]; then
+            echo "Error: no iteration count in the output of $program ($size points, $cores cores):" >&2
+            echo "$output" >&2
+            exit 1
+        fi
+        if [ -n "$run_iterations" ] && [ "$iterations" -ne "$run_iterations" ]; then
+            echo "Error: $program ($size points, $cores cores) did $run_iterations and $iterations iterations in different trials." >&2
+            exit 1
+        fi
+        run_iterations=$iterations
+        times="$times $load $compute"
+    done
+
+    echo "$times" | awk '{
+        n = NF / 2
+        for (i = 1; i <= n; i++) {
+            load_sum += $(2 * i - 1)
+            c[i] = $(2 * i)
+            compute_sum += c[i]
+        }
+        compute_mean = compute_sum / n
+        for (i = 1; i <= n; i++) {
+            var += (c[i] - compute_mean) ^ 2
+        }
+        std = n > 1 ? sqrt(var / (n - 1)) : 0
+        # Insertion sort for the median and the minimum
+        for (i = 2; i <= n; i++) {
+            v = c[i]
+            for (j = i - 1; j >= 1 && c[j] > v; j--) c[j + 1] = c[j]
+            c[j + 1] = v
+        }
+        median = n % 2 ? c[(n + 1) / 2] : (c[n / 2] + c[n / 2 + 1]) / 2
+        printf "%.6f %.6f %.6f %.6f %.6f", load_sum / n, compute_mean, std, c[1], median
+    }'
+    echo " $run_iterations"
+}
+
+# Appends one result line to the CSV file. Strong scaling compares runs on the same points, which must do
+# the same number of iterations as the serial run; weak scaling runs on more points than its reference,
+# which may converge in a different number of iterations, so it compares the time per iteration.
+# Arguments: mode, size, cores, stats of the run, stats of the reference (serial) run
+write_result() {
+    local mode=$1 size=$2 cores=$3 stats=$4 reference=$5
+    read -r load_mean compute_mean compute_std compute_min compute_median iterations <<< "$stats"
+    read -r _ _ _ _ reference_median reference_iterations <<< "$reference"
+    if [ "$mode" = "strong" ] && [ "$iterations" -ne "$reference_iterations" ]; then
+        echo "Error: $size points on $cores cores took $iterations iterations, the serial run $reference_iterations; the times are not comparable." >&2
+        echo "Check that the seeding matches the serial build and that EXTRA_ARGS does not change the iteration count." >&2
+        exit 1
+    fi
+    local per_iteration reference_per_iteration speedup efficiency
+    per_iteration=$(awk -v t="$compute_median" -v i="$iterations" 'BEGIN { printf "%.9f", t / i }')
+    reference_per_iteration=$(awk -v t="$reference_median" -v i="$reference_iterations" 'BEGIN { printf "%.9f", t / i }')
+    speedup=$(awk -v r="$reference_per_iteration" -v t="$per_iteration" 'BEGIN { printf "%.4f", (t > 0 ? r / t : 0) }')
+    if [ "$mode" = "weak" ]; then
+        # Weak scaling: p times the work in the same time is perfect efficiency
+        efficiency=$speedup
+        speedup=$(awk -v e="$efficiency" -v p="$cores" 'BEGIN { printf "%.4f", e * p }')
+    else
+        efficiency=$(awk -v s="$speedup" -v p="$cores" 'BEGIN { printf "%.4f", s / p }')
+    fi
+    echo "$mode,$size,$cores,$TRIALS,$load_mean,$compute_mean,$compute_std,$compute_min,$compute_median,$speedup,$efficiency,$iterations,$per_iteration" >> "$CSV_FILE"
+    echo "$mode scaling, $size points, $cores cores: median compute $compute_median s (+/- $compute_std) for $iterations iterations, speedup $speedup, efficiency $efficiency"
+}
+
+echo "mode,size,cores,trials,load_mean,compute_mean,compute_std,compute_min,compute_median,speedup,efficiency,iterations,seconds_per_iteration" > "$CSV_FILE"
+
+# Strong scaling: speedup against the serial build on the same size
+for SIZE in "${SUBSET_SIZES[@]}"
+do
+    echo "Running strong scaling on $SIZE points... ($(date))"
+    SERIAL_STATS=$(run_trials "$SERIAL_PROGRAM" "$SIZE" 0) || exit 1
+    write_result "serial" "$SIZE" 1 "$SERIAL_STATS" "$SERIAL_STATS"
+
+    for CORE in "${CORES[@]}"
+    do
+        STATS=$(run_trials "$PROGRAM" "$SIZE" "$CORE") || exit 1
+        write_result "strong" "$SIZE" "$CORE" "$STATS" "$SERIAL_STATS"
+    done
+done
+
+# Weak scaling: WEAK_SIZE points per core, compared with the serial build on WEAK_SIZE points
+echo "Running weak scaling with $WEAK_SIZE points per core... ($(date))"
+SERIAL_STATS=$(run_trials "$SERIAL_PROGRAM" "$WEAK_SIZE" 0) || exit 1
+for CORE in "${CORES[@]}"
+do
+    SIZE=$((WEAK_SIZE * CORE))
+    STATS=$(run_trials "$PROGRAM" "$SIZE" "$CORE") || exit 1
+    write_result "weak" "$SIZE" "$CORE" "$STATS" "$SERIAL_STATS"
+done
+
+# JSON copy of the CSV results
+awk -F, 'NR == 1 { for (i = 1; i <= NF; i++) key[i] = $i; printf "[\n"; next }
+    {
+        printf "%s  {", (NR > 2 ? ",\n" : "")
+        for (i = 1; i <= NF; i++) {
+            value = i == 1 ? "\"" $i "\"" : $i
+            printf "\"%s\": %s%s", key[i], value, (i < NF ? ", " : "")
+        }
+        printf "}"
+    }
+    END { printf "\n]\n" }' "$CSV_FILE" > "$JSON_FILE"
+
+echo "Results written to $CSV_FILE and $JSON_FILE"
+
+if [ "$1" = "--save-baseline" ]; then
+    cp "$CSV_FILE" "$BASELINE_FILE"
+    echo "Baseline saved to $BASELINE_FILE"
+    exit 0
+fi
+
+# Regression check against the stored baseline (same mode, size and cores). The time per iteration is
+# compared, and a configuration whose iteration count changed is reported as well.
+if [ -f "$BASELINE_FILE" ]; then
+    awk -F, -v tolerance="$TOLERANCE" '
+        NR == FNR {
+            if (FNR == 1 && NF < 13) {
+                print "Error: the baseline has no iteration counts; save a new one with --save-baseline."
+                failed = 1
+                exit 1
+            }
+            if (FNR > 1) {
+                baseline[$1 "," $2 "," $3] = $13
+                baseline_iterations[$1 "," $2 "," $3] = $12
+            }
+            next
+        }
+        FNR > 1 {
+            key = $1 "," $2 "," $3
+            if (!(key in baseline) || baseline[key] <= 0) next
+            if ($12 != baseline_iterations[key]) {
+                printf "ITERATIONS CHANGED: %s scaling, %s points, %s cores: %d vs baseline %d\n", $1, $2, $3, $12, baseline_iterations[key]
+                regressions++
+            }
+            change = ($13 - baseline[key]) / baseline[key]
+            if (change > tolerance) {
+                printf "REGRESSION: %s scaling, %s points, %s cores: %.6f s/iteration vs baseline %.6f s/iteration (+%.1f%%)\n", $1, $2, $3, $13, baseline[key], 100 * change
+                regressions++
+            }
+        }
+        END {
+            if (failed || regressions > 0) exit 1
+            print "No regressions against the baseline."
+        }' "$BASELINE_FILE" "$CSV_FILE" || exit 1
+fi
@@ -0,0 +1,269 @@
+#include "stream.h"
+#include "kmeans.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <poll.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock StreamClock;
+
+// A cluster that received none of the last STALE_BATCHES * batch_size points is moved to a new point
+static const size_t STALE_BATCHES = 10;
+
+// The first batch waits for num_clusters distinct points at most this many times the usual batch size and latency
+static const int SEED_WAIT_BATCHES = 4;
+
+// Longer input lines are skipped, so a stream without newlines cannot grow the line buffer
+static const size_t MAX_LINE_LENGTH = 4096;
+
+// k-means++ seeding on the buffered points: one random point, then D^2-weighted draws
+static void seedCentroids(KMeans& kmeans, const std::vector<Point>& points, std::vector<Centroid>& centroids, int num_clusters) {
+    kmeans.num_clusters = 1;
+    kmeans.initializeCentroids(centroids, points);
+    while (static_cast<int>(centroids.size()) < num_clusters) {
+        kmeans.addCentroid(centroids, points);
+    }
+}
+
+// Moves centroid c to a point of the batch drawn with probability proportional to its weighted
+// squared distance from the nearest centroid, as in k-means++
+static bool reseedCentroid(KMeans& kmeans, const std::vector<Point>& batch, std::vector<Centroid>& centroids, int c) {
+    std::vector<double> distances(batch.size());
+    double total = 0.0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        double min_distance_sq = std::numeric_limits<double>::max();
+        for (const auto& centroid : centroids) {
+            double dx = batch[i].x - centroid.x;
+            double dy = batch[i].y - centroid.y;
+            min_distance_sq = std::min(min_distance_sq, dx * dx + dy * dy);
+        }
+        distances[i] = batch[i].weight * min_distance_sq;
+        total += distances[i];
+    }
+    if (total <= 0.0) {
+        return false;
+    }
+
+    double target = total * (kmeans.random.next() / (RAND_MAX + 1.0));
+    size_t chosen = batch.size() - 1;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        target -= distances[i];
+        if (target < 0.0) {
+            chosen = i;
+            break;
+        }
+    }
+    centroids[c].updateCoordinates(batch[chosen].x, batch[chosen].y);
+    return true;
+}
+
+// Labels one micro-batch and folds it into the centroids with decaying weights
+static void processBatch(KMeans& kmeans, std::vector<Point>& batch, std::vector<Centroid>& centroids,
+                         std::vector<double>& cluster_weights, std::vector<size_t>& points_since_hit,
+                         size_t stale_points, double decay) {
+    kmeans.assignPointsToClusters(batch, centroids);
+
+    int K = kmeans.num_clusters;
+    std::vector<double> sum_x(K, 0.0), sum_y(K, 0.0), weights(K, 0.0);
+    for (const auto& point : batch) {
+        sum_x[point.cluster_id] += point.weight * point.x;
+        sum_y[point.cluster_id] += point.weight * point.y;
+        weights[point.cluster_id] += point.weight;
+    }
+
+    for (int c = 0; c < K; ++c) {
+        double previous_weight = decay * cluster_weights[c];
+        cluster_weights[c] = previous_weight + weights[c];
+        if (weights[c] > 0.0) {
+            centroids[c].updateCoordinates(
+                (previous_weight * centroids[c].x + sum_x[c]) / cluster_weights[c],
+                (previous_weight * centroids[c].y + sum_y[c]) / cluster_weights[c]);
+            points_since_hit[c] = 0;
+        } else {
+            points_since_hit[c] += batch.size();
+        }
+    }
+
+    // Clusters that stay empty (dead seeds, or data that moved away) restart from a far point
+    for (int c = 0; c < K; ++c) {
+        if (points_since_hit[c] >= stale_points && reseedCentroid(kmeans, batch, centroids, c)) {
+            cluster_weights[c] = 0.0;
+            points_since_hit[c] = 0;
+        }
+    }
+
+    std::string labels;
+    for (const auto& point : batch) {
+        labels += std::to_string(point.cluster_id);
+        labels += '\n';
+    }
+    std::cout << labels << std::flush;
+}
+
+void runStream(int num_clusters, size_t batch_size, int max_latency_ms, double decay) {
+    KMeans kmeans(num_clusters, 0);
+    std::vector<Centroid> centroids;
+    std::vector<double> cluster_weights(num_clusters, 0.0);
+    std::vector<size_t> points_since_hit(num_clusters, 0);
+
+    // Until num_clusters distinct points have arrived the first batch may grow to SEED_WAIT_BATCHES times
+    // the batch size, so that the seeds are distinct; memory is bounded by that batch, one read buffer
+    // and one line of at most MAX_LINE_LENGTH characters
+    std::vector<Point> distinct_points;
+    std::vector<Point> batch;
+    batch.reserve(batch_size);
+    std::string pending;
+    char buffer[65536];
+
+    bool end_of_input = false;
+    bool skipping_line = false;
+    size_t num_points = 0, num_batches = 0, skipped_lines = 0;
+    double total_latency = 0.0, max_latency = 0.0;
+    StreamClock::time_point batch_start = StreamClock::now();
+
+    // Size and latency limits of the batch being filled; larger while waiting for distinct seeds
+    auto waitingForSeeds = [&]() {
+        return centroids.empty() && static_cast<int>(distinct_points.size()) < num_clusters;
+    };
+    auto batchLimit = [&]() {
+        return waitingForSeeds() ? SEED_WAIT_BATCHES * batch_size : batch_size;
+    };
+    auto latencyLimit = [&]() {
+        return waitingForSeeds() ? SEED_WAIT_BATCHES * max_latency_ms : max_latency_ms;
+    };
+
+    auto flushBatch = [&]() {
+        if (centroids.empty()) {
+            if (waitingForSeeds()) {
+                std::cerr << "Warning: only " << distinct_points.size() << " distinct points for " << num_clusters
+                          << " clusters in the first batch; coinciding centroids move once other points arrive." << std::endl;
+            }
+            seedCentroids(kmeans, batch, centroids, num_clusters);
+            std::vector<Point>().swap(distinct_points);
+
+            // Centroids that coincide with an earlier one are reseeded as soon as the data allows
+            for (size_t c = 1; c < centroids.size(); ++c) {
+                for (size_t other = 0; other < c; ++other) {
+                    if (centroids[c].x == centroids[other].x && centroids[c].y == centroids[other].y) {
+                        points_since_hit[c] = STALE_BATCHES * batch_size;
+                        break;
+                    }
+                }
+            }
+        }
+        processBatch(kmeans, batch, centroids, cluster_weights, points_since_hit, STALE_BATCHES * batch_size, decay);
+        std::chrono::duration<double, std::milli> latency = StreamClock::now() - batch_start;
+        total_latency += latency.count();
+        max_latency = std::max(max_latency, latency.count());
+        num_points += batch.size();
+        num_batches++;
+        batch.clear();
+    };
+
+    auto parseLine = [&](const std::string& line) {
+        const char* line_cstr = line.c_str();
+        char* end_ptr;
+        double x = std::strtod(line_cstr, &end_ptr);
+        if (end_ptr == line_cstr || *end_ptr != ',') {
+            skipped_lines++;
+            return;
+        }
+        const char* y_cstr = end_ptr + 1;
+        double y = std::strtod(y_cstr, &end_ptr);
+        if (end_ptr == y_cstr) {
+            skipped_lines++;
+            return;
+        }
+
+        if (batch.empty()) {
+            batch_start = StreamClock::now();
+        }
+        batch.emplace_back(x, y);
+
+        if (centroids.empty() && static_cast<int>(distinct_points.size()) < num_clusters) {
+            bool seen = false;
+            for (const auto& point : distinct_points) {
+                if (point.x == x && point.y == y) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (!seen) {
+                distinct_points.emplace_back(x, y);
+            }
+        }
+        if (batch.size() >= batchLimit()) {
+            flushBatch();
+        }
+    };
+
+    while (!end_of_input) {
+        // Wait for input at most until the deadline of the batch being filled
+        int timeout = -1;
+        if (!batch.empty()) {
+            std::chrono::duration<double, std::milli> waited = StreamClock::now() - batch_start;
+            timeout = std::max(0, latencyLimit() - static_cast<int>(waited.count()));
+        }
+
+        pollfd input = {STDIN_FILENO, POLLIN, 0};
+        int ready = poll(&input, 1, timeout);
+        if (ready > 0) {
+            ssize_t received = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (received <= 0) {
+                end_of_input = true;
+            } else {
+                pending.append(buffer, received);
+                size_t line_start = 0;
+                size_t newline;
+                while ((newline = pending.find('\n', line_start)) != std::string::npos) {
+                    if (skipping_line) {
+                        skipping_line = false;
+                    } else {
+                        parseLine(pending.substr(line_start, newline - line_start));
+                    }
+                    line_start = newline + 1;
+                }
+                pending.erase(0, line_start);
+
+                // Drop an over-long line and everything up to its newline
+                if (pending.size() > MAX_LINE_LENGTH) {
+                    if (!skipping_line) {
+                        skipped_lines++;
+                        skipping_line = true;
+                    }
+                    pending.clear();
+                }
+            }
+        } else if (ready < 0) {
+            std::cerr << "Error waiting for input on stdin." << std::endl;
+            end_of_input = true;
+        }
+
+        std::chrono::duration<double, std::milli> waited = StreamClock::now() - batch_start;
+        if (!batch.empty() && waited.count() >= latencyLimit()) {
+            flushBatch();
+        }
+    }
+
+    // Last line without a newline, then whatever is left in the batch
+    if (!pending.empty() && !skipping_line) {
+        parseLine(pending);
+    }
+    if (!batch.empty()) {
+        flushBatch();
+    }
+
+    std::cerr << "Stream: " << num_points << " points in " << num_batches << " batches";
+    if (num_batches > 0) {
+        std::cerr << ", batch latency mean " << total_latency / num_batches << " ms, max " << max_latency << " ms";
+    }
+    std::cerr << ", " << skipped_lines << " lines skipped." << std::endl;
+    for (const auto& centroid : centroids) {
+        std::cerr << "Centroid " << centroid.id << ": " << centroid.x << ", " << centroid.y << std::endl;
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <cstddef>
+
+// Online clustering of "x,y" lines read from stdin. Points are grouped in micro-batches of at most
+// batch_size points, and a batch is processed at the latest max_latency_ms after its first point arrived.
+// Each batch is labelled with the current centroids and then folded into them; earlier batches count
+// decay times less at every batch (1 keeps a running mean). Labels are written to stdout, one per line.
+// The centroids are seeded by k-means++ once num_clusters distinct points have arrived (the first batch waits
+// for them, up to 4 times the batch size and latency), and a cluster that stays empty for 10 batches' worth
+// of points restarts from a far point.
+void runStream(int num_clusters, size_t batch_size, int max_latency_ms, double decay);
+
+#endif
@@ -0,0 +1,140 @@
+#include "sweep.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <chrono>
+#include <omp.h>
+
+double sampledSilhouette(const std::vector<Point>& points, int num_clusters, int samples, RandomGenerator& random) {
+    if (num_clusters < 2 || points.size() < 2) {
+        return 0.0;
+    }
+
+    // Sample drawn in proportion to the point weights, so every dataset row is equally likely
+    std::vector<double> cumulative_weight(points.size());
+    double total_weight = 0.0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        total_weight += points[i].weight;
+        cumulative_weight[i] = total_weight;
+    }
+
+    std::vector<size_t> sample(samples);
+    for (size_t s = 0; s < sample.size(); ++s) {
+        double target = total_weight * (random.next() / (RAND_MAX + 1.0));
+        size_t index = std::upper_bound(cumulative_weight.begin(), cumulative_weight.end(), target) - cumulative_weight.begin();
+        sample[s] = std::min(index, points.size() - 1);
+    }
+
+    int S = static_cast<int>(sample.size());
+    double total = 0.0;
+
+    #pragma omp parallel default(none) shared(points, sample, num_clusters, S) reduction(+:total)
+    {
+        // Per-thread distance sums and counts towards each cluster
+        std::vector<double> sums(num_clusters);
+        std::vector<int> counts(num_clusters);
+
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < S; ++i) {
+            const Point& p = points[sample[i]];
+            std::fill(sums.begin(), sums.end(), 0.0);
+            std::fill(counts.begin(), counts.end(), 0);
+
+            for (int j = 0; j < S; ++j) {
+                if (j == i) {
+                    continue;
+                }
+                const Point& q = points[sample[j]];
+                double dx = p.x - q.x;
+                double dy = p.y - q.y;
+                sums[q.cluster_id] += std::sqrt(dx * dx + dy * dy);
+                counts[q.cluster_id] += 1;
+            }
+
+            // Points alone in their cluster (within the sample) score 0
+            int own = p.cluster_id;
+            if (counts[own] == 0) {
+                continue;
+            }
+            double a = sums[own] / counts[own];
+            double b = std::numeric_limits<double>::max();
+            for (int c = 0; c < num_clusters; ++c) {
+                if (c != own && counts[c] > 0 && sums[c] / counts[c] < b) {
+                    b = sums[c] / counts[c];
+                }
+            }
+            if (b == std::numeric_limits<double>::max()) {
+                continue;
+            }
+            double denominator = std::max(a, b);
+            if (denominator > 0.0) {
+                total += (b - a) / denominator;
+            }
+        }
+    }
+
+    return total / S;
+}
+
+void runSweep(KMeans& kmeans, std::vector<Point>& points, std::vector<Centroid>& centroids, int k_max, int silhouette_samples) {
+    int k_min = kmeans.num_clusters;
+    std::vector<int> ks;
+    std::vector<double> inertias, silhouettes;
+
+    kmeans.verbose = false;
+
+    for (int k = k_min; k <= k_max; ++k) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // K+1 starts from the K solution plus one k-means++ centroid
+        if (k > k_min) {
+            kmeans.addCentroid(centroids, points);
+        }
+        kmeans.start_iteration = 0;
+        kmeans.run(points, centroids);
+
+        // Labels and inertia for the final centroid positions (the assignment step measures the inertia)
+        kmeans.assignPointsToClusters(points, centroids, true);
+        double inertia = kmeans.inertia;
+        double silhouette = sampledSilhouette(points, k, silhouette_samples, kmeans.random);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end - start;
+
+        std::cout << "K=" << k << ": inertia " << inertia << ", silhouette " << silhouette << ", "
+                  << kmeans.completed_iterations << " iterations"
+                  << (kmeans.has_converged ? "" : " (not converged)") << ", "
+                  << duration.count() << " seconds." << std::endl;
+
+        ks.push_back(k);
+        inertias.push_back(inertia);
+        silhouettes.push_back(silhouette);
+    }
+
+    // Elbow: the K farthest below the straight line joining the first and last (K, inertia) points
+    size_t elbow = 0;
+    if (ks.size() >= 3 && inertias.front() > inertias.back()) {
+        double best_gap = -std::numeric_limits<double>::max();
+        for (size_t i = 0; i < ks.size(); ++i) {
+            double x = static_cast<double>(ks[i] - ks.front()) / (ks.back() - ks.front());
+            double y = (inertias[i] - inertias.back()) / (inertias.front() - inertias.back());
+            double gap = 1.0 - x - y;
+            if (gap > best_gap) {
+                best_gap = gap;
+                elbow = i;
+            }
+        }
+    }
+
+    size_t best_silhouette = 0;
+    for (size_t i = 1; i < ks.size(); ++i) {
+        if (silhouettes[i] > silhouettes[best_silhouette]) {
+            best_silhouette = i;
+        }
+    }
+
+    std::cout << "Elbow at K=" << ks[elbow] << " (inertia " << inertias[elbow] << "), best silhouette at K="
+              << ks[best_silhouette] << " (" << silhouettes[best_silhouette] << ")." << std::endl;
+}
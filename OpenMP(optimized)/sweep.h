@@ -0,0 +1,14 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include "kmeans.h"
+
+// Clusters the same points for K = kmeans.num_clusters .. k_max, seeding each K+1 run from the K solution.
+// Prints inertia and a sampled silhouette score per K followed by an elbow summary.
+void runSweep(KMeans& kmeans, std::vector<Point>& points, std::vector<Centroid>& centroids, int k_max, int silhouette_samples);
+
+// Mean silhouette of a random sample of points (drawn by weight), computed against the other sampled points only
+double sampledSilhouette(const std::vector<Point>& points, int num_clusters, int samples, RandomGenerator& random);
+
+#endif